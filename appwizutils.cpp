@@ -0,0 +1,58 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "appwizutils.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+bool AppWizUtils::isLinglongDesktopFile(const QString & desktopFilePath)
+{
+    return desktopFilePath.contains("/persistent/linglong") || desktopFilePath.contains("/var/lib/linglong");
+}
+
+QString AppWizUtils::linglongAppId(const Dtk::Core::DDesktopEntry & entry)
+{
+    return entry.rawValue("Exec").section(' ', 2, 2);
+}
+
+QString AppWizUtils::compatibleRemoveCommand(const QString & desktopFilePath)
+{
+    const QString compatibleDesktopJsonPath("/var/lib/deepin-compatible/compatibleDesktop.json");
+    if (!QFile::exists(compatibleDesktopJsonPath)) {
+        return QString();
+    }
+
+    // the json uses the following format:
+    // {
+    //     "environment-name-package-name": {
+    //          ...,
+    //          "RemoveCommand": "deepin-compatible-ctl app --name environment-name remove -- package-name"
+    //     },
+    //     "environment-name2-package-name2": {...},
+    //     ...
+    // }
+    // Check if desktopFilePath's file name (without `.desktop` suffix) is in the json file. If so, return
+    // its RemoveCommand.
+    QFile jsonFile(compatibleDesktopJsonPath);
+    if (!jsonFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return QString();
+    }
+
+    QJsonDocument jsonDoc = QJsonDocument::fromJson(jsonFile.readAll());
+    if (!jsonDoc.isObject()) {
+        return QString();
+    }
+
+    QJsonObject jsonObj = jsonDoc.object();
+    for (const QString & key : jsonObj.keys()) {
+        if (!desktopFilePath.endsWith(key + ".desktop")) continue;
+        qDebug() << "Found compatible desktop entry" << key << "in" << compatibleDesktopJsonPath;
+        return jsonObj.value(key).toObject().value("RemoveCommand").toString();
+    }
+
+    return QString();
+}
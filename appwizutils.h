@@ -0,0 +1,20 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QString>
+
+#include <DDesktopEntry>
+
+// Helpers shared by the per-session Launcher1Compat and the system-wide ApplicationWizard1,
+// so both of them detect the package type of a desktop file in the same way.
+namespace AppWizUtils {
+    // Whether the desktop file is provided by a Linglong bundle
+    bool isLinglongDesktopFile(const QString & desktopFilePath);
+    // The Linglong app id, taken from the `ll-cli run <appId>` Exec line
+    QString linglongAppId(const Dtk::Core::DDesktopEntry & entry);
+    // The RemoveCommand of a DCM compatible-mode application, or an empty string if it's not one
+    QString compatibleRemoveCommand(const QString & desktopFilePath);
+}
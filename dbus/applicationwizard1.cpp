@@ -0,0 +1,303 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "applicationwizard1.h"
+
+#include "appwizutils.h"
+#include "pkutils.h"
+
+#include <DDesktopEntry>
+#include <applicationwizard1adaptor.h> // this is the adapter of ApplicationWizard1
+
+#include <QCoroDBusPendingCall>
+#include <QCoroProcess>
+
+#include <QDBusArgument>
+#include <QDBusConnection>
+#include <QDBusObjectPath>
+#include <QDBusVariant>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QProcess>
+
+#include <limits>
+#include <stdexcept>
+
+#include <pwd.h>
+
+DCORE_USE_NAMESPACE
+
+namespace {
+
+class AccessDenied : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// Waiting for the user to type in the password (polkit) or for the package manager can
+// take much longer than the default D-Bus timeout.
+constexpr int NoTimeout = std::numeric_limits<int>::max();
+
+QString errorMessage(const std::exception & e)
+{
+    const PKUtils::PkError * pkErr = PKUtils::PkError::castFromStdException(e);
+    if (pkErr) {
+        return pkErr->reason();
+    }
+    return QString::fromUtf8(e.what());
+}
+
+QString userName(uint uid)
+{
+    const struct passwd * pw = getpwuid(uid);
+    return pw ? QString::fromLocal8Bit(pw->pw_name) : QString();
+}
+
+// We are already root here, so the uninstaller is executed directly instead of via pkexec.
+QCoro::Task<void> runUninstaller(const QString program, const QStringList arguments)
+{
+    qDebug() << "Running" << program << arguments;
+    QProcess process;
+    const bool started = co_await qCoro(process).start(program, arguments);
+    if (!started) {
+        qWarning() << "Failed to start" << program << process.error() << process.errorString();
+        throw std::runtime_error(process.errorString().toStdString());
+    }
+    co_await qCoro(process).waitForFinished(-1);
+    if (process.error() == QProcess::FailedToStart || process.error() == QProcess::Crashed) {
+        qWarning() << program << "failed:" << process.error() << process.errorString();
+        throw std::runtime_error(process.errorString().toStdString());
+    }
+
+    const QByteArray standardError = process.readAllStandardError();
+    qDebug() << "stdout:" << process.readAllStandardOutput();
+    qDebug() << "stderr:" << standardError;
+
+    if (process.exitStatus() != QProcess::NormalExit || process.exitCode() != 0) {
+        throw std::runtime_error(standardError.trimmed().toStdString());
+    }
+
+    co_return;
+}
+
+}
+
+ApplicationWizard1::ApplicationWizard1(QObject *parent)
+    : QObject(parent)
+    , m_applicationWizard1Adapter(new ApplicationWizard1Adaptor(this))
+{
+}
+
+// Returns the uid of the caller. Throws AccessDenied if the caller is rejected.
+QCoro::Task<uint> ApplicationWizard1::checkCaller(const QDBusMessage message)
+{
+    QDBusMessage credentialsCall = QDBusMessage::createMethodCall("org.freedesktop.DBus",
+                                                                  "/org/freedesktop/DBus",
+                                                                  "org.freedesktop.DBus",
+                                                                  "GetConnectionCredentials");
+    credentialsCall << message.service();
+    const QDBusMessage credentialsReply = co_await QDBusConnection::systemBus().asyncCall(credentialsCall);
+    if (credentialsReply.type() != QDBusMessage::ReplyMessage || credentialsReply.arguments().isEmpty()) {
+        qWarning() << "Unable to get the credentials of" << message.service() << credentialsReply.errorMessage();
+        throw AccessDenied("unable to identify the caller");
+    }
+    const QVariantMap credentials = qdbus_cast<QVariantMap>(credentialsReply.arguments().constFirst());
+    if (!credentials.contains("UnixUserID") || !credentials.contains("ProcessID")) {
+        throw AccessDenied("unable to identify the caller");
+    }
+    const uint uid = credentials.value("UnixUserID").toUInt();
+    const uint pid = credentials.value("ProcessID").toUInt();
+
+#ifndef QT_DEBUG
+    // This only filters out unexpected callers, it's NOT a security boundary: the compat daemon
+    // runs as the user, who can also start it with LD_PRELOAD. Polkit does the real check.
+    QString procfs = QLatin1String("/proc/%1/exe").arg(QString::number(pid));
+    QString realPath = QFileInfo(procfs).canonicalFilePath();
+    if (realPath != QStringLiteral(DAEMON_COMPAT_PATH)) {
+        qWarning() << realPath << "is not the compat daemon";
+        throw AccessDenied("caller is not the compat daemon");
+    }
+#else
+    Q_UNUSED(pid);
+#endif // !QT_DEBUG
+
+    // The calling user must have a graphical session. We look the user up by uid instead of
+    // GetSessionByPID(): the compat daemon runs as a systemd user service which lives outside
+    // of any session scope, and the pid might have been reused already.
+    QDBusMessage userCall = QDBusMessage::createMethodCall("org.freedesktop.login1",
+                                                           "/org/freedesktop/login1",
+                                                           "org.freedesktop.login1.Manager",
+                                                           "GetUser");
+    userCall << uid;
+    const QDBusMessage userReply = co_await QDBusConnection::systemBus().asyncCall(userCall);
+    if (userReply.type() != QDBusMessage::ReplyMessage || userReply.arguments().isEmpty()) {
+        qWarning() << "Caller uid" << uid << "is not logged in:" << userReply.errorMessage();
+        throw AccessDenied("caller is not logged in");
+    }
+    const QDBusObjectPath userPath = userReply.arguments().constFirst().value<QDBusObjectPath>();
+
+    QDBusMessage propsCall = QDBusMessage::createMethodCall("org.freedesktop.login1",
+                                                            userPath.path(),
+                                                            "org.freedesktop.DBus.Properties",
+                                                            "Get");
+    propsCall << QStringLiteral("org.freedesktop.login1.User") << QStringLiteral("Display");
+    const QDBusMessage propsReply = co_await QDBusConnection::systemBus().asyncCall(propsCall);
+    if (propsReply.type() != QDBusMessage::ReplyMessage || propsReply.arguments().isEmpty()) {
+        throw AccessDenied("unable to get the graphical session of the caller");
+    }
+
+    // Display is a (so) struct: id and object path of the user's graphical session
+    const QVariant display = propsReply.arguments().constFirst().value<QDBusVariant>().variant();
+    if (display.userType() != qMetaTypeId<QDBusArgument>()) {
+        throw AccessDenied("unable to get the graphical session of the caller");
+    }
+    const QDBusArgument displayArg = display.value<QDBusArgument>();
+    if (displayArg.currentSignature() != QLatin1String("(so)")) {
+        throw AccessDenied("unable to get the graphical session of the caller");
+    }
+    QString sessionId;
+    QDBusObjectPath sessionPath;
+    displayArg.beginStructure();
+    displayArg >> sessionId >> sessionPath;
+    displayArg.endStructure();
+    if (sessionId.isEmpty()) {
+        qWarning() << "Caller uid" << uid << "has no graphical session";
+        throw AccessDenied("caller has no graphical session");
+    }
+
+    co_return uid;
+}
+
+// Ask polkit, on behalf of the caller, whether it's allowed to perform the given action.
+QCoro::Task<void> ApplicationWizard1::authorize(const QDBusMessage message, const QString actionId)
+{
+    QDBusArgument subject;
+    subject.beginStructure();
+    subject << QStringLiteral("system-bus-name") << QVariantMap{{QStringLiteral("name"), message.service()}};
+    subject.endStructure();
+
+    QDBusArgument details;
+    details.beginMap(QMetaType::fromType<QString>(), QMetaType::fromType<QString>());
+    details.endMap();
+
+    QDBusMessage authCall = QDBusMessage::createMethodCall("org.freedesktop.PolicyKit1",
+                                                           "/org/freedesktop/PolicyKit1/Authority",
+                                                           "org.freedesktop.PolicyKit1.Authority",
+                                                           "CheckAuthorization");
+    // flags: 0x1 = AllowUserInteraction
+    authCall << QVariant::fromValue(subject) << actionId << QVariant::fromValue(details) << uint(1) << QString();
+    const QDBusMessage authReply = co_await QDBusConnection::systemBus().asyncCall(authCall, NoTimeout);
+    if (authReply.type() != QDBusMessage::ReplyMessage || authReply.arguments().isEmpty()) {
+        qWarning() << "Polkit authorization check failed:" << authReply.errorMessage();
+        throw AccessDenied("polkit authorization check failed");
+    }
+
+    // (bba{ss}): is_authorized, is_challenge, details
+    bool isAuthorized = false;
+    bool isChallenge = false;
+    QMap<QString, QString> resultDetails;
+    const QDBusArgument resultArg = authReply.arguments().constFirst().value<QDBusArgument>();
+    resultArg.beginStructure();
+    resultArg >> isAuthorized >> isChallenge >> resultDetails;
+    resultArg.endStructure();
+    if (!isAuthorized) {
+        throw AccessDenied("not authorized");
+    }
+
+    co_return;
+}
+
+QCoro::Task<void> ApplicationWizard1::uninstall(const QDBusMessage message, const QString desktop)
+{
+    const uint uid = co_await checkCaller(message);
+
+    // Nothing below may touch the caller-provided path before polkit authorized the caller,
+    // otherwise the error replies would tell whether a root-only path exists. Thus the action
+    // is picked by the path string and root-owned state only.
+    if (!QDir::isAbsolutePath(desktop) || QDir::cleanPath(desktop) != desktop) {
+        throw std::runtime_error("desktop file path must be an absolute, clean path");
+    }
+
+    // Use the same polkit action as the pkexec (or PackageKit) call in Launcher1Compat, so the
+    // system service doesn't change which polkit rules apply.
+    const bool isLinglong = AppWizUtils::isLinglongDesktopFile(desktop);
+    const QString removeCommand = isLinglong ? QString() : AppWizUtils::compatibleRemoveCommand(desktop);
+    const bool isOstree = QFile::exists("/run/ostree-booted");
+    QString actionId;
+    if (isLinglong) {
+        actionId = QStringLiteral("org.deepin.dde.appwiz.uninstall.linglong");
+    } else if (!removeCommand.isEmpty()) {
+        actionId = QStringLiteral("org.deepin.dde.appwiz.uninstall.compatible");
+    } else if (isOstree) {
+        actionId = QStringLiteral("org.deepin.dde.appwiz.uninstall");
+    } else {
+        actionId = QStringLiteral("org.freedesktop.packagekit.package-remove");
+    }
+    co_await authorize(message, actionId);
+
+    // Launcher1Compat sends the canonical path, don't follow a symlink to something else than
+    // what the caller has been authorized for.
+    QFileInfo desktopFileInfo(desktop);
+    if (desktopFileInfo.isSymLink()) {
+        throw std::runtime_error("desktop file path is a symlink, its canonical path is expected");
+    }
+    if (!desktopFileInfo.exists()) {
+        throw std::runtime_error("desktop file doesn't exist");
+    }
+
+    DDesktopEntry desktopEntry(desktop);
+    if (desktopEntry.status() != DDesktopEntry::NoError) {
+        throw std::runtime_error("desktop file is invalid");
+    }
+
+    qDebug() << "Uninstalling" << desktop << "for uid" << uid;
+
+    if (isLinglong) {
+        const QString appId = AppWizUtils::linglongAppId(desktopEntry);
+        co_await runUninstaller(QStringLiteral(LIBEXECDIR "/dde-appwiz-linglong-uninstaller.sh"), QStringList{appId});
+        co_return;
+    }
+
+    if (!removeCommand.isEmpty()) {
+        QStringList args = removeCommand.split(' ');
+        args.prepend("SUDO_USER=" + userName(uid));
+        co_await runUninstaller("env", args);
+        co_return;
+    }
+
+    if (isOstree) {
+        co_await runUninstaller(QStringLiteral(LIBEXECDIR "/dde-appwiz-uninstaller.sh"), QStringList{desktop});
+        co_return;
+    }
+
+    const PKUtils::PkPackages packages = co_await PKUtils::searchFiles(desktop, PackageKit::Transaction::FilterInstalled);
+    if (packages.size() == 0) {
+        throw std::runtime_error("no matching package found");
+    }
+    for (const PKUtils::PkPackage & pkg : packages) {
+        QString pkgId;
+        std::tie(std::ignore, pkgId, std::ignore) = pkg;
+        co_await PKUtils::removePackage(pkgId);
+    }
+
+    co_return;
+}
+
+// the 1st argument is the full path of a desktop file. The reply is sent once the
+// uninstallation is finished, or an error reply if it failed.
+void ApplicationWizard1::Uninstall(const QString & desktop)
+{
+    setDelayedReply(true);
+    const QDBusMessage msg = message();
+
+    uninstall(msg, desktop).then([msg](){
+        QDBusConnection::systemBus().send(msg.createReply());
+    }, [msg, desktop](const std::exception & e){
+        const bool denied = dynamic_cast<const AccessDenied *>(&e) != nullptr;
+        qWarning() << "Uninstall" << desktop << "failed:" << errorMessage(e);
+        QDBusConnection::systemBus().send(msg.createErrorReply(denied ? QDBusError::AccessDenied : QDBusError::Failed,
+                                                               errorMessage(e)));
+    });
+}
@@ -0,0 +1,40 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QDBusContext>
+#include <QDBusMessage>
+#include <QObject>
+
+#include <QCoroTask>
+
+// System bus service which does the privileged part of the uninstallation for every
+// user session, so there is only one PackageKit client on the whole machine. When built
+// with ENABLE_SYSTEM_SERVICE, the per-session Launcher1Compat always forwards requests
+// here without any fallback, so both must be installed together.
+class ApplicationWizard1Adaptor;
+class ApplicationWizard1 : public QObject, protected QDBusContext
+{
+    Q_OBJECT
+public:
+    static ApplicationWizard1 &instance()
+    {
+        static ApplicationWizard1 _instance;
+        return _instance;
+    }
+
+// ApplicationWizard1Adaptor
+public:
+    void Uninstall(const QString &desktop);
+
+private:
+    explicit ApplicationWizard1(QObject *parent = nullptr);
+
+    QCoro::Task<uint> checkCaller(const QDBusMessage message);
+    QCoro::Task<void> authorize(const QDBusMessage message, const QString actionId);
+    QCoro::Task<void> uninstall(const QDBusMessage message, const QString desktop);
+
+    ApplicationWizard1Adaptor * m_applicationWizard1Adapter;
+};
@@ -4,12 +4,28 @@
 
 #include "launcher1compat.h"
 
-#include "pkutils.h"
+#include "appwizutils.h"
 
 #include <DDesktopEntry>
 #include <DNotifySender>
 #include <launcher1adaptor.h> // this is the adapter of daemon.Launcher1
 
+#include <QDBusConnection>
+#include <QDBusConnectionInterface>
+#include <QFile>
+#include <QFileInfo>
+#include <QProcess>
+#include <QStandardPaths>
+
+#ifdef ENABLE_SYSTEM_SERVICE
+#include <applicationwizard1interface.h> // this is the proxy of the system-wide ApplicationWizard1
+
+#include <QDBusPendingCallWatcher>
+
+#include <limits>
+#else
+#include "pkutils.h"
+
 // PackageKit-Qt
 #include <Daemon>
 
@@ -18,6 +34,7 @@
 #include <QPixmap>
 #include <QBuffer>
 #include <QByteArray>
+#endif // ENABLE_SYSTEM_SERVICE
 
 // Ends with a slash, this is the install prefix for the trusted launcher app.
 // For package maintianers, if your distro install binaries to weird locations,
@@ -28,6 +45,7 @@
 
 DCORE_USE_NAMESPACE
 
+#ifndef ENABLE_SYSTEM_SERVICE
 QString qIconToBase64(const QIcon &icon)
 {
     if (icon.isNull()) {
@@ -55,12 +73,25 @@ QString qIconToBase64(const QIcon &icon)
     
     return dataUri;
 }
+#endif // !ENABLE_SYSTEM_SERVICE
 
 Launcher1Compat::Launcher1Compat(QObject *parent)
     : QObject(parent)
     , m_daemonLauncher1Adapter(new Launcher1Adaptor(this))
+#ifdef ENABLE_SYSTEM_SERVICE
+    , m_systemService(new OrgDeepinDdeApplicationWizard1Interface("org.deepin.dde.ApplicationWizard1",
+                                                                  "/org/deepin/dde/ApplicationWizard1",
+                                                                  QDBusConnection::systemBus(), this))
+#endif // ENABLE_SYSTEM_SERVICE
 {
+#ifdef ENABLE_SYSTEM_SERVICE
+    // All the privileged work is done by the system-wide service, we only forward the request
+    // and do the per-user cleanup, thus there is no need to talk to PackageKit at all.
+    // Uninstallation might wait for user's authentication, don't time out.
+    m_systemService->setTimeout(std::numeric_limits<int>::max());
+#else
     PackageKit::Daemon::setHints(QStringList{"interactive=true"});
+#endif // ENABLE_SYSTEM_SERVICE
 }
 
 Launcher1Compat::~Launcher1Compat()
@@ -82,17 +113,6 @@ void sendNotification(const QString & displayName, bool successed, const QString
     notifySender.call();
 }
 
-bool uninstallLinglongBundle(const DDesktopEntry & entry)
-{
-    const QString appId = entry.rawValue("Exec").section(' ', 2, 2);
-    QProcess process;
-    qDebug() << "Uninstalling Linglong bundle" << appId << "via script";
-    process.start("pkexec", QStringList{"/usr/libexec/dde-appwiz-linglong-uninstaller.sh", appId});
-    process.waitForFinished();
-    
-    return process.exitCode() == 0;
-}
-
 void postUninstallCleanUp(const QString & desktopId, PackageType packageType)
 {
     // Remove the shortcut that we created at user's desktop
@@ -119,6 +139,18 @@ void postUninstallCleanUp(const QString & desktopId, PackageType packageType)
     // TODO: the legacy dde-application-manager didn't do this
 }
 
+#ifndef ENABLE_SYSTEM_SERVICE
+bool uninstallLinglongBundle(const DDesktopEntry & entry)
+{
+    const QString appId = AppWizUtils::linglongAppId(entry);
+    QProcess process;
+    qDebug() << "Uninstalling Linglong bundle" << appId << "via script";
+    process.start("pkexec", QStringList{"/usr/libexec/dde-appwiz-linglong-uninstaller.sh", appId});
+    process.waitForFinished();
+    
+    return process.exitCode() == 0;
+}
+
 void Launcher1Compat::uninstallPackageKitPackage(const QString & pkgDisplayName, const QString & pkPackageId)
 {
     qDebug() << "Uninstall" << pkPackageId << "via PackageKit";
@@ -180,6 +212,34 @@ void Launcher1Compat::uninstallPackageByScript(const QString & pkgDisplayName, c
     }
 }
 
+#else
+void Launcher1Compat::uninstallViaSystemService(const QString & pkgDisplayName, const QString & packageDesktopFilePath)
+{
+    qDebug() << "Uninstall" << pkgDisplayName << packageDesktopFilePath << "via the system service";
+    const QString iconName = m_base64Icon;
+    const PackageType packageType = AppWizUtils::isLinglongDesktopFile(packageDesktopFilePath) ? PackageType::Linglong
+                                                                                               : PackageType::Deb;
+
+    QDBusPendingCallWatcher * watcher = new QDBusPendingCallWatcher(m_systemService->Uninstall(packageDesktopFilePath), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [=, this](QDBusPendingCallWatcher * self) {
+        const QDBusPendingReply<> reply = *self;
+        self->deleteLater();
+        if (reply.isError()) {
+            qDebug() << "Uninstall" << packageDesktopFilePath << "failed:" << reply.error().name() << reply.error().message();
+            emit UninstallFailed(packageDesktopFilePath, reply.error().message());
+            sendNotification(pkgDisplayName, false, iconName);
+            return;
+        }
+
+        QFileInfo fi(packageDesktopFilePath);
+        // FIXME: THIS IS NOT DESKTOP ID
+        postUninstallCleanUp(fi.fileName(), packageType);
+        emit UninstallSuccess(packageDesktopFilePath);
+        sendNotification(pkgDisplayName, true, iconName);
+    });
+}
+#endif // ENABLE_SYSTEM_SERVICE
+
 // the 1st argument is the full path of a desktop file.
 void Launcher1Compat::RequestUninstall(const QString & desktop, bool skipPreinstallHook)
 {
@@ -220,11 +280,16 @@ void Launcher1Compat::RequestUninstall(const QString & desktop, bool skipPreinst
         qDebug() << "use default icon";
         m_base64Icon = "application-default-icon";
     } else {
+#ifdef ENABLE_SYSTEM_SERVICE
+        // There is no QGuiApplication in forwarder mode, let the notification server look up the icon
+        m_base64Icon = appIconName;
+#else
         QIcon appIcon = QIcon::fromTheme(appIconName);
         if(appIcon.isNull()) {
             m_base64Icon = "application-default-icon";
         }
         m_base64Icon = qIconToBase64(appIcon);
+#endif // ENABLE_SYSTEM_SERVICE
     }
 
     if (!skipPreinstallHook && !desktopEntry.stringValue("X-Deepin-PreUninstall").isEmpty()) {
@@ -259,8 +324,13 @@ void Launcher1Compat::RequestUninstall(const QString & desktop, bool skipPreinst
         }
     }
 
+#ifdef ENABLE_SYSTEM_SERVICE
+    // Privileged part is done by the system-wide service, which only accepts absolute, clean paths
+    // without any symlink, so resolve the whole chain here instead of a single symLinkTarget() level.
+    uninstallViaSystemService(desktopEntry.ddeDisplayName(), desktopFileInfo.canonicalFilePath());
+#else
     // Check and do uninstallation
-    if (desktopFilePath.contains("/persistent/linglong") || desktopFilePath.contains("/var/lib/linglong")) {
+    if (AppWizUtils::isLinglongDesktopFile(desktopFilePath)) {
         // Uninstall Linglong Bundle
         bool succ = uninstallLinglongBundle(desktopEntry);
         if (!succ) {
@@ -278,35 +348,10 @@ void Launcher1Compat::RequestUninstall(const QString & desktop, bool skipPreinst
     } else {
         m_packageDisplayName = desktopEntry.ddeDisplayName();
 
-        const QString compatibleDesktopJsonPath("/var/lib/deepin-compatible/compatibleDesktop.json");
-        if (QFile::exists(compatibleDesktopJsonPath)) {
-            qDebug() << "Found compatibleDesktop.json, checking if" << m_packageDisplayName << "is a compatible-mode application.";
-            // the json uses the following format:
-            // {
-            //     "environment-name-package-name": {
-            //          ...,
-            //          "RemoveCommand": "deepin-compatible-ctl app --name environment-name remove -- package-name"
-            //     },
-            //     "environment-name2-package-name2": {...},
-            //     ...
-            // }
-            // Check if desktopFilePath's file name (without `.desktop` suffix) is in the json file. If so, execute the
-            // RemoveCommand via `pkexec`.
-            QFile jsonFile(compatibleDesktopJsonPath);
-            if (jsonFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-                QJsonDocument jsonDoc = QJsonDocument::fromJson(jsonFile.readAll());
-                if (jsonDoc.isObject()) {
-                    QJsonObject jsonObj = jsonDoc.object();
-                    for (const QString & key : jsonObj.keys()) {
-                        if (!desktopFilePath.endsWith(key + ".desktop")) continue;
-                        QJsonObject obj = jsonObj.value(key).toObject();
-                        QString removeCommand = obj.value("RemoveCommand").toString();
-                        qDebug() << "Found compatible desktop entry" << m_packageDisplayName << "in" << compatibleDesktopJsonPath;
-                        uninstallDCMPackage(m_packageDisplayName, removeCommand);
-                        return;
-                    }
-                }
-            }
+        const QString removeCommand = AppWizUtils::compatibleRemoveCommand(desktopFilePath);
+        if (!removeCommand.isEmpty()) {
+            uninstallDCMPackage(m_packageDisplayName, removeCommand);
+            return;
         }
 
         // Uninstall regular package via PackageKit or deepin-store
@@ -329,4 +374,5 @@ void Launcher1Compat::RequestUninstall(const QString & desktop, bool skipPreinst
             });
         }
     }
+#endif // ENABLE_SYSTEM_SERVICE
 }
@@ -16,6 +16,9 @@ enum class PackageType {
 };
 
 class Launcher1Adaptor;
+#ifdef ENABLE_SYSTEM_SERVICE
+class OrgDeepinDdeApplicationWizard1Interface;
+#endif // ENABLE_SYSTEM_SERVICE
 class Launcher1Compat : public QObject, protected QDBusContext
 {
     Q_OBJECT
@@ -38,11 +41,19 @@ signals:
 private:
     explicit Launcher1Compat(QObject *parent = nullptr);
 
+#ifdef ENABLE_SYSTEM_SERVICE
+    void uninstallViaSystemService(const QString & pkgDisplayName, const QString & packageDesktopFilePath);
+#else
     void uninstallPackageKitPackage(const QString & pkgDisplayName, const QString & pkPackageId);
     void uninstallDCMPackage(const QString & pkgDisplayName, const QString & uninstallCmd);
     void uninstallPackageByScript(const QString & pkgDisplayName, const QString & packageDesktopFilePath);
+#endif // ENABLE_SYSTEM_SERVICE
 
     Launcher1Adaptor * m_daemonLauncher1Adapter;
+#ifdef ENABLE_SYSTEM_SERVICE
+    // Proxy of the system-wide ApplicationWizard1 service, which does all the privileged work
+    OrgDeepinDdeApplicationWizard1Interface * m_systemService;
+#endif // ENABLE_SYSTEM_SERVICE
 
     // TODO: vvv This is bad, refactor this later vvv
     QString m_packageDisplayName;
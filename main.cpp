@@ -2,26 +2,45 @@
 //
 // SPDX-License-Identifier: GPL-3.0-or-later
 
-#include <QGuiApplication>
 #include <QDBusConnection>
 #include <QDebug>
+
+#ifdef ENABLE_SYSTEM_SERVICE
+#include <QCoreApplication>
+#include <QLocale>
+#include <QTranslator>
+#else
+#include <QGuiApplication>
 #include <DGuiApplicationHelper>
+#endif // ENABLE_SYSTEM_SERVICE
 
 #include "dbus/launcher1compat.h"
 
 int main(int argc, char* argv[])
 {
+#ifdef ENABLE_SYSTEM_SERVICE
+    // The per-session daemon only forwards requests to the system service here, so it doesn't
+    // need the GUI stack (platform plugin, icon theme) nor DGuiApplicationHelper.
+    QCoreApplication app(argc, argv);
+    app.setApplicationName(QStringLiteral("dde-application-wizard"));
+
+    QTranslator translator;
+    if (translator.load(QLocale(), app.applicationName(), QStringLiteral("_"), QStringLiteral(TRANSLATIONS_DIR))) {
+        app.installTranslator(&translator);
+    }
+#else
     QGuiApplication app(argc, argv);
     app.setQuitOnLastWindowClosed(false);
     app.setApplicationName(QStringLiteral("dde-application-wizard"));
 
     Dtk::Gui::DGuiApplicationHelper::loadTranslator();
+#endif // ENABLE_SYSTEM_SERVICE
 
     QDBusConnection connection = QDBusConnection::sessionBus();
     if (!connection.registerService(QStringLiteral("org.deepin.dde.daemon.Launcher1")) ||
         !connection.registerObject(QStringLiteral("/org/deepin/dde/daemon/Launcher1"), &Launcher1Compat::instance())) {
         qFatal("register dbus service failed");
     }
-  
+
     return app.exec();
 }
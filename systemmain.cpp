@@ -0,0 +1,25 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <QCoreApplication>
+#include <QDBusConnection>
+#include <QDebug>
+
+#include "dbus/applicationwizard1.h"
+
+// The system-wide uninstall service shared by all user sessions. There is no display on
+// the system bus side, so it doesn't need a QGuiApplication.
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName(QStringLiteral("dde-application-wizard"));
+
+    QDBusConnection connection = QDBusConnection::systemBus();
+    if (!connection.registerService(QStringLiteral("org.deepin.dde.ApplicationWizard1")) ||
+        !connection.registerObject(QStringLiteral("/org/deepin/dde/ApplicationWizard1"), &ApplicationWizard1::instance())) {
+        qFatal("register dbus service failed");
+    }
+
+    return app.exec();
+}